@@ -0,0 +1,94 @@
+#!/usr/bin/env python3
+
+# Compares the list based aInScanRead path (new ctypes buffer and list
+# for every read, then volts() for every sample) with the NumPy path
+# (preallocated array filled in place, then aInScanVolts()).
+#
+# No device is needed: the USB read is replaced by a memmove from a
+# buffer of synthetic samples, so the numbers are the Python side
+# overhead on top of the transfer itself. libmccusb.so must still be
+# on LD_LIBRARY_PATH for the conversion functions.
+#
+# usage: bench_ainscan.py [nscan] [nreads]
+
+from __future__ import print_function
+import ctypes
+import sys
+import time
+
+import numpy
+
+import mccusb
+
+
+NCHAN = 4  # differential channels
+CHANNELS = 0x0f
+OPTIONS = 0
+
+
+class SimulatedDevice(mccusb.MCCUSB1208FSPlusDevice):
+
+    def __init__(self, nscan):
+        # No device is opened; reads copy from a pregenerated block.
+        self.part_number = 'USB-1208FS-Plus (simulated)'
+        self._device_handle = None
+        self._source = (numpy.arange(nscan * NCHAN, dtype=numpy.uint32) * 7919 % 4096).astype(numpy.uint16)
+        # Seed the per-class function cache so aInScanRead() picks it up.
+        SimulatedDevice._funcs = {'usbAInScanRead_USB1208FS_Plus': self._read}
+
+    def _read(self, handle, nscan, nchan, buf, options, timeout):
+        nbytes = nscan * nchan * 2
+        ctypes.memmove(buf, self._source.ctypes.data, nbytes)
+        return nbytes
+
+
+def legacy_read(dev, nscan, table, ranges):
+    # What a caller had to do before: a fresh buffer and list per read,
+    # then calibration and volts() one sample at a time.
+    buf = (ctypes.c_uint16 * (nscan * NCHAN))()
+    dev._read(None, nscan, NCHAN, buf, OPTIONS, 1000)
+    data = [val for val in buf]
+    volts = mccusb.getfunc('volts_USB1208FS_Plus', [ctypes.c_uint16, ctypes.c_uint8], ctypes.c_double)
+    result = []
+    for i, value in enumerate(data):
+        chan = i % NCHAN
+        slope, offset = table[ranges[chan]][chan]
+        code = int(round(value * slope + offset))
+        code = min(max(code, 0), dev.ADC_MAX)
+        result.append(volts(code, ranges[chan]))
+    return result
+
+
+def main():
+    nscan = int(sys.argv[1]) if len(sys.argv) > 1 else 1024
+    nreads = int(sys.argv[2]) if len(sys.argv) > 2 else 20
+    nsamples = nscan * NCHAN * nreads
+
+    dev = SimulatedDevice(nscan)
+    ranges = [dev.BP_10V, dev.BP_5V, dev.BP_2V, dev.BP_1V]
+    table = [[[1.0 + 0.001 * (i + j), -0.5 * j] for j in range(dev.NCHAN_DE)]
+             for i in range(dev.NGAINS_USB1208FS_PLUS)]
+
+    start = time.time()
+    for _ in range(nreads):
+        legacy = legacy_read(dev, nscan, table, ranges)
+    t_legacy = time.time() - start
+
+    conv = dev.scanConverter(CHANNELS, ranges, table=table)
+    block = numpy.empty((nscan, NCHAN), dtype=numpy.uint16)
+    volts = numpy.empty((nscan, NCHAN), dtype=numpy.float64)
+    start = time.time()
+    for _ in range(nreads):
+        dev.aInScanRead(nscan, NCHAN, OPTIONS, 1000, out=block)
+        dev.aInScanVolts(block, conv, out=volts)
+    t_numpy = time.time() - start
+
+    err = numpy.max(numpy.abs(volts.ravel() - numpy.array(legacy)))
+    print('%d reads of %d scans x %d channels' % (nreads, nscan, NCHAN))
+    print('  list + volts() per sample   %10.3f Msamples/s' % (nsamples / t_legacy * 1e-6))
+    print('  NumPy + aInScanVolts()      %10.3f Msamples/s  (%.0fx)' % (nsamples / t_numpy * 1e-6, t_legacy / t_numpy))
+    print('  max difference              %10.3g V' % err)
+
+
+if __name__ == '__main__':
+    main()
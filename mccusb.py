@@ -1,6 +1,11 @@
 import os
 from ctypes import *
 
+try:
+    import numpy
+except ImportError:
+    numpy = None
+
 
 # Do not load shared library when building docs.
 # This allows building docs in any pure Python environment.
@@ -28,12 +33,44 @@ def sequence_to_array(seq, member_type, length=None):
     return (member_type * length)(*flat)
 
 
+def buffer_to_array(buf, member_type, length):
+    # Wrap a writable buffer (NumPy array, bytearray, array.array, ...)
+    # as a ctypes array of the given length without copying. NumPy
+    # arrays must be C-contiguous and of the matching dtype.
+    if numpy is not None and isinstance(buf, numpy.ndarray):
+        if buf.dtype != numpy.dtype(member_type) or not buf.flags.c_contiguous or not buf.flags.writeable:
+            raise ValueError('expected a writable C-contiguous array of %s' % numpy.dtype(member_type))
+        if buf.size < length:
+            raise ValueError('array holds %d elements, %d required' % (buf.size, length))
+    return (member_type * length).from_buffer(buf)
+
+
+# Constants from <libusb/usb-convert.h>
+CONVERT_MAX_CHAN = 64
+CONVERT_MAX_PERIOD = 8 * CONVERT_MAX_CHAN
+
+
+class ScanConvert(Structure):
+    # struct usbScanConvert_t from <libusb/usb-convert.h>
+    _fields_ = [
+        ('nChan', c_int),
+        ('period', c_int),
+        ('maxCode', c_uint32),
+        ('slope', c_double * CONVERT_MAX_PERIOD),
+        ('offset', c_double * CONVERT_MAX_PERIOD),
+        ('base', c_double * CONVERT_MAX_PERIOD),
+        ('lsb', c_double * CONVERT_MAX_PERIOD),
+    ]
+
+
 class DeviceNotFoundError(Exception):
     pass
 
 
 class MCCUSBDevice(object):
 
+    _device_handle = None
+
     def __init__(self, part_number, product_id):
         self.part_number = part_number
         # libusb_device_handle* usb_device_find_USB_MCC(int productId, char *serialID);
@@ -44,6 +81,46 @@ class MCCUSBDevice(object):
         else:
             self._device_handle = device_handle
 
+    def close(self):
+        # Releases the device and frees the driver state kept for its
+        # handle. The device can not be used afterwards.
+        if self._device_handle is None:
+            return
+        # int libusb_release_interface(libusb_device_handle *dev, int interface_number);
+        f = self._func('libusb_release_interface', [c_void_p, c_int], c_int)
+        f(self._device_handle, 0)
+        # void usb_device_close_USB_MCC(libusb_device_handle *udev);
+        f = self._func('usb_device_close_USB_MCC', [c_void_p], None)
+        f(self._device_handle)
+        self._device_handle = None
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        self.close()
+
+    def __del__(self):
+        try:
+            self.close()
+        except Exception:
+            # The library may already be unloaded at interpreter exit.
+            pass
+
+    @classmethod
+    def _func(cls, name, argtypes, restype):
+        # Same as getfunc, but the configured function is resolved once
+        # and cached on the class.
+        funcs = cls.__dict__.get('_funcs')
+        if funcs is None:
+            funcs = {}
+            setattr(cls, '_funcs', funcs)
+        try:
+            return funcs[name]
+        except KeyError:
+            func = funcs[name] = getfunc(name, argtypes, restype)
+            return func
+
 
 class MCCUSB1208FSPlusDevice(MCCUSBDevice):
 
@@ -133,6 +210,7 @@ class MCCUSB1208FSPlusDevice(MCCUSBDevice):
     NCHAN_AOUT              =  2  # max number of D/A 12 bit 0-5V output channels
     NGAINS_USB1208FS_PLUS   =  8  # max number of input gain levels (differential mode only)
     MAX_PACKET_SIZE         = 64  # max packet size for FS device
+    ADC_MAX                 = 0xfff  # full scale code of the 12 bit A/D
 
     PORTA     = 0  # DIO Port A
     PORTB     = 1  # DIO Port B
@@ -142,210 +220,343 @@ class MCCUSB1208FSPlusDevice(MCCUSBDevice):
 
     def dTristateR(self, port):
         # uint8_t usbDTristateR_USB1208FS_Plus(libusb_device_handle *udev, uint8_t port);
-        f = getfunc('usbDTristateR_USB1208FS_Plus', [c_void_p, c_uint8], c_uint8)
+        f = self._func('usbDTristateR_USB1208FS_Plus', [c_void_p, c_uint8], c_uint8)
         return f(self._device_handle, port)
 
     def dTristateW(self, port, value):
         # void usbDTristateW_USB1208FS_Plus(libusb_device_handle *udev, uint8_t port, uint8_t value);
-        f = getfunc('usbDTristateW_USB1208FS_Plus', [c_void_p, c_uint8, c_uint8], None)
+        f = self._func('usbDTristateW_USB1208FS_Plus', [c_void_p, c_uint8, c_uint8], None)
         f(self._device_handle, port, value)
 
     def dPort(self, port):
         # uint8_t usbDPort_USB1208FS_Plus(libusb_device_handle *udev, uint8_t port);
-        f = getfunc('usbDPort_USB1208FS_Plus', [c_void_p, c_uint8], c_uint8)
+        f = self._func('usbDPort_USB1208FS_Plus', [c_void_p, c_uint8], c_uint8)
         return f(self._device_handle, port)
 
     def dLatchR(self, port):
         # uint8_t usbDLatchR_USB1208FS_Plus(libusb_device_handle *udev, uint8_t port);
-        f = getfunc('usbDLatchR_USB1208FS_Plus', [c_void_p, c_uint8], c_uint8)
+        f = self._func('usbDLatchR_USB1208FS_Plus', [c_void_p, c_uint8], c_uint8)
         return f(self._device_handle, port)
 
     def dLatchW(self, port, value):
         # void usbDLatchW_USB1208FS_Plus(libusb_device_handle *udev, uint8_t port, uint8_t value);
-        f = getfunc('usbDLatchW_USB1208FS_Plus', [c_void_p, c_uint8, c_uint8], None)
+        f = self._func('usbDLatchW_USB1208FS_Plus', [c_void_p, c_uint8, c_uint8], None)
         f(self._device_handle, port, value)
 
     def aIn(self, channel, mode, range_):
         # uint16_t usbAIn_USB1208FS_Plus(libusb_device_handle *udev, uint8_t channel, uint8_t mode, uint8_t range);
-        f = getfunc('usbAIn_USB1208FS_Plus', [c_void_p, c_uint8, c_uint8, c_uint8], c_uint16)
+        f = self._func('usbAIn_USB1208FS_Plus', [c_void_p, c_uint8, c_uint8, c_uint8], c_uint16)
         return f(self._device_handle, channel, mode, range_)
 
     def aInScanStart(self, count, retrig_count, frequency, channels, options):
         # void usbAInScanStart_USB1208FS_Plus(libusb_device_handle *udev, uint32_t count, uint32_t retrig_count, double frequency, uint8_t channels, uint8_t options);
-        f = getfunc('usbAInScanStart_USB1208FS_Plus', [c_void_p, c_uint32, c_uint32, c_double, c_uint8, c_uint8], None)
+        f = self._func('usbAInScanStart_USB1208FS_Plus', [c_void_p, c_uint32, c_uint32, c_double, c_uint8, c_uint8], None)
         f(self._device_handle, count, retrig_count, frequency, channels, options)
 
     def aInScanConfig(self, ranges):
         # void usbAInScanConfig_USB1208FS_Plus(libusb_device_handle *udev, uint8_t ranges[8]);
-        f = getfunc('usbAInScanConfig_USB1208FS_Plus', [c_void_p, c_uint8 * 8], None)
+        f = self._func('usbAInScanConfig_USB1208FS_Plus', [c_void_p, c_uint8 * 8], None)
         f(self._device_handle, sequence_to_array(ranges, c_uint8, 8))
 
     def aInScanConfigR(self, ranges):
         # void usbAInScanConfigR_USB1208FS_Plus(libusb_device_handle *udev, uint8_t *ranges);
-        f = getfunc('usbAInScanConfigR_USB1208FS_Plus', [c_void_p, POINTER(c_uint8)], None)
+        f = self._func('usbAInScanConfigR_USB1208FS_Plus', [c_void_p, POINTER(c_uint8)], None)
         f(self._device_handle, sequence_to_array(ranges, c_uint8))
 
-    def aInScanRead(self, nscan, nchan, options, timeout, buffersize):
+    def aInScanRead(self, nscan, nchan, options, timeout, buffersize=None, out=None):
+        """Read nscan scans of nchan channels.
+
+        Returns ``(ret, data)``, where ``ret`` is the return value of
+        the C function (number of bytes read, negative on error).
+
+        If ``out`` is given, the samples are written straight into it,
+        without any copy, and ``out`` is returned as ``data``. ``out``
+        may be a C-contiguous ``numpy.uint16`` array or any other
+        writable buffer holding at least ``nscan * nchan`` 16-bit
+        samples; arrays of shape ``(nscan, nchan)`` work well.
+        Otherwise ``data`` is a new list of ``buffersize`` samples
+        (default ``nscan * nchan``), as before.
+        """
         # int usbAInScanRead_USB1208FS_Plus(libusb_device_handle *udev, int nScan, int nChan, uint16_t *data, uint8_t options, int timeout);
-        f = getfunc('usbAInScanRead_USB1208FS_Plus', [c_void_p, c_int, c_int, POINTER(c_uint16), c_uint8, c_int], c_int)
-        buf = (c_uint16 * buffersize)()
-        ret = f(self._device_handle, nscan, nchan, buf, options, timeout)
-        return ret, [val for val in buf]
+        f = self._func('usbAInScanRead_USB1208FS_Plus', [c_void_p, c_int, c_int, POINTER(c_uint16), c_uint8, c_int], c_int)
+        nsamples = nscan * nchan
+        if buffersize is None:
+            buffersize = nsamples
+        if out is None:
+            buf = (c_uint16 * buffersize)()
+            ret = f(self._device_handle, nscan, nchan, buf, options, timeout)
+            return ret, [val for val in buf]
+        ret = f(self._device_handle, nscan, nchan, buffer_to_array(out, c_uint16, nsamples), options, timeout)
+        return ret, out
+
+    def aInScanBlocks(self, nscan, nchan, frequency, channels, options, timeout, nblocks=4):
+        """Run a continuous scan and yield blocks of ``nscan`` scans.
+
+        The scan is started with ``aInScanStart`` and read in blocks of
+        shape ``(nscan, nchan)`` (``numpy.uint16``). The blocks come
+        from a pool of ``nblocks`` arrays allocated up front, so a block
+        is only valid until ``nblocks - 1`` more blocks have been
+        yielded; copy it if it has to be kept longer. The scan is
+        stopped when the generator is closed or garbage collected.
+        Raises ``IOError`` if a read fails.
+        """
+        if numpy is None:
+            raise RuntimeError('aInScanBlocks requires NumPy')
+        pool = [numpy.empty((nscan, nchan), dtype=numpy.uint16) for _ in range(nblocks)]
+        options |= self.CONTINUOUS
+        self.aInScanStart(0, 0, frequency, channels, options)
+        try:
+            i = 0
+            while True:
+                block = pool[i % nblocks]
+                ret, _ = self.aInScanRead(nscan, nchan, options, timeout, out=block)
+                if ret < 0:
+                    raise IOError('usbAInScanRead_USB1208FS_Plus failed: %d' % ret)
+                yield block
+                i += 1
+        finally:
+            self.aInScanStop()
+            self.aInScanClearFIFO()
 
     def aInScanStop(self):
         # void usbAInScanStop_USB1208FS_Plus(libusb_device_handle *udev);
-        f = getfunc('usbAInScanStop_USB1208FS_Plus', [c_void_p], None)
+        f = self._func('usbAInScanStop_USB1208FS_Plus', [c_void_p], None)
         f(self._device_handle)
 
     def aInScanClearFIFO(self):
         # void usbAInScanClearFIFO_USB1208FS_Plus(libusb_device_handle *udev);
-        f = getfunc('usbAInScanClearFIFO_USB1208FS_Plus', [c_void_p], None)
+        f = self._func('usbAInScanClearFIFO_USB1208FS_Plus', [c_void_p], None)
         f(self._device_handle)
 
     def aOut(self, channel, value):
         # void usbAOut_USB1208FS_Plus(libusb_device_handle *udev, uint8_t channel, uint16_t value);
-        f = getfunc('usbAOut_USB1208FS_Plus', [c_void_p, c_uint8, c_uint16], None)
+        f = self._func('usbAOut_USB1208FS_Plus', [c_void_p, c_uint8, c_uint16], None)
         f(self._device_handle, channel, value)
 
     def aOutR(self, channel):
         # uint16_t usbAOutR_USB1208FS_Plus(libusb_device_handle *udev, uint8_t channel);
-        f = getfunc('usbAOutR_USB1208FS_Plus', [c_void_p, c_uint8], c_uint16)
+        f = self._func('usbAOutR_USB1208FS_Plus', [c_void_p, c_uint8], c_uint16)
         return f(self._device_handle, channel)
 
     def aOutScanStop(self):
         # void usbAOutScanStop_USB1208FS_Plus(libusb_device_handle *udev);
-        f = getfunc('usbAOutScanStop_USB1208FS_Plus', [c_void_p], None)
+        f = self._func('usbAOutScanStop_USB1208FS_Plus', [c_void_p], None)
         f(self._device_handle)
 
     def aOutScanClearFIFO(self):
         # void usbAOutScanClearFIFO_USB1208FS_Plus(libusb_device_handle *udev);
-        f = getfunc('usbAOutScanClearFIFO_USB1208FS_Plus', [c_void_p], None)
+        f = self._func('usbAOutScanClearFIFO_USB1208FS_Plus', [c_void_p], None)
         f(self._device_handle)
 
     def aInBulkFlush(self, count):
         # void usbAInBulkFlush_USB1208FS_Plus(libusb_device_handle *udev, uint8_t count);
-        f = getfunc('usbAInBulkFlush_USB1208FS_Plus', [c_void_p, c_uint8], None)
+        f = self._func('usbAInBulkFlush_USB1208FS_Plus', [c_void_p, c_uint8], None)
         f(self._device_handle, count)
 
     def aOutScanStart(self, count, frequency, options):
         # void usbAOutScanStart_USB1208FS_Plus(libusb_device_handle *udev, uint32_t count, double frequency, uint8_t options);
-        f = getfunc('usbAOutScanStart_USB1208FS_Plus', [c_void_p, c_uint32, c_double, c_uint8], None)
+        f = self._func('usbAOutScanStart_USB1208FS_Plus', [c_void_p, c_uint32, c_double, c_uint8], None)
         f(self._device_handle, count, frequency, options)
 
     def counter(self):
         # uint32_t usbCounter_USB1208FS_Plus(libusb_device_handle *udev);
-        f = getfunc('usbCounter_USB1208FS_Plus', [c_void_p], c_uint32)
+        f = self._func('usbCounter_USB1208FS_Plus', [c_void_p], c_uint32)
         return f(self._device_handle)
 
     def counterInit(self):
         # void usbCounterInit_USB1208FS_Plus(libusb_device_handle *udev);
-        f = getfunc('usbCounterInit_USB1208FS_Plus', [c_void_p], None)
+        f = self._func('usbCounterInit_USB1208FS_Plus', [c_void_p], None)
         f(self._device_handle)
 
     def readCalMemory(self, address, count, buffersize):
         # void usbReadCalMemory_USB1208FS_Plus(libusb_device_handle *udev, uint16_t address, uint16_t count, uint8_t memory[]);
-        f = getfunc('usbReadCalMemory_USB1208FS_Plus', [c_void_p, c_uint16, c_uint16, POINTER(c_uint8)], None)
+        f = self._func('usbReadCalMemory_USB1208FS_Plus', [c_void_p, c_uint16, c_uint16, POINTER(c_uint8)], None)
         buf = (c_uint8 * buffersize)()
         f(self._device_handle, address, count, buf)
         return [val for val in buf]
 
     def writeCalMemory(self, address, count, data):
         # void usbWriteCalMemory_USB1208FS_Plus(libusb_device_handle *udev, uint16_t address,  uint16_t count, uint8_t data[]);
-        f = getfunc('usbWriteCalMemory_USB1208FS_Plus', [c_void_p, c_uint16, c_uint16, POINTER(c_uint8)], None)
+        f = self._func('usbWriteCalMemory_USB1208FS_Plus', [c_void_p, c_uint16, c_uint16, POINTER(c_uint8)], None)
         f(self._device_handle, address, count, sequence_to_array(data, c_uint8))
 
     def readUserMemory(self, address, count, buffersize):
         # void usbReadUserMemory_USB1208FS_Plus(libusb_device_handle *udev, uint16_t address, uint16_t count, uint8_t memory[]);
-        f = getfunc('usbReadUserMemory_USB1208FS_Plus', [c_void_p, c_uint16, c_uint16, POINTER(c_uint8)], None)
+        f = self._func('usbReadUserMemory_USB1208FS_Plus', [c_void_p, c_uint16, c_uint16, POINTER(c_uint8)], None)
         buf = (c_uint8 * buffersize)()
         f(self._device_handle, address, count, buf)
         return [val for val in buf]
 
     def writeUserMemory(self, address, count, data):
         # void usbWriteUserMemory_USB1208FS_Plus(libusb_device_handle *udev, uint16_t address,  uint16_t count, uint8_t data[]);
-        f = getfunc('usbWriteUserMemory_USB1208FS_Plus', [c_void_p, c_uint16, c_uint16, POINTER(c_uint8)], None)
+        f = self._func('usbWriteUserMemory_USB1208FS_Plus', [c_void_p, c_uint16, c_uint16, POINTER(c_uint8)], None)
         f(self._device_handle, address, count, sequence_to_array(data, c_uint8))
 
     def readMBDMemory(self, address, count, buffersize):
         # void usbReadMBDMemory_USB1208FS_Plus(libusb_device_handle *udev, uint16_t address, uint16_t count, uint8_t memory[]);
-        f = getfunc('usbReadMBDMemory_USB1208FS_Plus', [c_void_p, c_uint16, c_uint16, POINTER(c_uint8)], None)
+        f = self._func('usbReadMBDMemory_USB1208FS_Plus', [c_void_p, c_uint16, c_uint16, POINTER(c_uint8)], None)
         buf = (c_uint8 * buffersize)()
         f(self._device_handle, address, count, buf)
         return [val for val in buf]
 
     def writeMBDMemory(self, address, count, data):
         # void usbWriteMBDMemory_USB1208FS_Plus(libusb_device_handle *udev, uint16_t address,  uint16_t count, uint8_t data[]);
-        f = getfunc('usbWriteMBDMemory_USB1208FS_Plus', [c_void_p, c_uint16, c_uint16, POINTER(c_uint8)], None)
+        f = self._func('usbWriteMBDMemory_USB1208FS_Plus', [c_void_p, c_uint16, c_uint16, POINTER(c_uint8)], None)
         f(self._device_handle, address, count, sequence_to_array(data, c_uint8))
 
     def blink(self, count):
         # void usbBlink_USB1208FS_Plus(libusb_device_handle *udev, uint8_t count);
-        f = getfunc('usbBlink_USB1208FS_Plus', [c_void_p, c_uint8], None)
+        f = self._func('usbBlink_USB1208FS_Plus', [c_void_p, c_uint8], None)
         f(self._device_handle, count)
 
     def reset(self):
         # void usbReset_USB1208FS_Plus(libusb_device_handle *udev);
-        f = getfunc('usbReset_USB1208FS_Plus', [c_void_p], None)
+        f = self._func('usbReset_USB1208FS_Plus', [c_void_p], None)
         f(self._device_handle)
 
     def status(self):
         # uint16_t usbStatus_USB1208FS_Plus(libusb_device_handle *udev);
-        f = getfunc('usbStatus_USB1208FS_Plus', [c_void_p], c_uint16)
+        f = self._func('usbStatus_USB1208FS_Plus', [c_void_p], c_uint16)
         return f(self._device_handle)
 
     def getSerialNumber(self):
         # void usbGetSerialNumber_USB1208FS_Plus(libusb_device_handle *udev, char serial[9]);
-        f = getfunc('usbGetSerialNumber_USB1208FS_Plus', [c_void_p, c_char * 9], None)
+        f = self._func('usbGetSerialNumber_USB1208FS_Plus', [c_void_p, c_char * 9], None)
         buf = create_string_buffer(9)
         f(self._device_handle, buf)
         return b''.join(ch for ch in buf if ch != b'\x00')
 
     def dfu(self):
         # void usbDFU_USB1208FS_Plus(libusb_device_handle *udev);
-        f = getfunc('usbDFU_USB1208FS_Plus', [c_void_p], None)
+        f = self._func('usbDFU_USB1208FS_Plus', [c_void_p], None)
         f(self._device_handle)
 
     def mbdCommand(self, str_):
         # void usbMBDCommand_USB1208FS_Plus(libusb_device_handle *udev, uint8_t str[]);
-        f = getfunc('usbMBDCommand_USB1208FS_Plus', [c_void_p, POINTER(c_uint8)], None)
+        f = self._func('usbMBDCommand_USB1208FS_Plus', [c_void_p, POINTER(c_uint8)], None)
         f(self._device_handle, sequence_to_array(str_, c_uint8))
 
     def mbdRaw(self, cmd, size):
         # void usbMBDRaw_USB1208FS_Plus(libusb_device_handle *udev, uint8_t cmd[], uint16_t size);
-        f = getfunc('usbMBDRaw_USB1208FS_Plus', [c_void_p, POINTER(c_uint8), c_uint16], None)
+        f = self._func('usbMBDRaw_USB1208FS_Plus', [c_void_p, POINTER(c_uint8), c_uint16], None)
         f(self._device_handle, sequence_to_array(cmd, c_uint8))
 
     def cleanup(self):
         # void cleanup_USB1208FS_Plus(libusb_device_handle *udev);
-        f = getfunc('cleanup_USB1208FS_Plus', [c_void_p], None)
+        # Closes the handle, so close() has nothing left to do.
+        if self._device_handle is None:
+            return
+        f = self._func('cleanup_USB1208FS_Plus', [c_void_p], None)
         f(self._device_handle)
+        self._device_handle = None
+
+    def buildGainTableDE(self, table_DE=None):
+        """Read the differential calibration table from the device.
 
-    def buildGainTableDE(self, table_DE):
+        Returns the table, indexed ``[range][channel][slope/offset]``.
+        If ``table_DE`` is given it is filled in as well.
+        """
         # void usbBuildGainTable_DE_USB1208FS_Plus(libusb_device_handle *udev, float table_DE[NGAINS_USB1208FS_PLUS][NCHAN_DE][2]);
         table_type = c_float * 2 * self.NCHAN_DE * self.NGAINS_USB1208FS_PLUS
-        f = getfunc('usbBuildGainTable_DE_USB1208FS_Plus', [c_void_p, table_type], None)
+        f = self._func('usbBuildGainTable_DE_USB1208FS_Plus', [c_void_p, table_type], None)
         table = table_type()
+        f(self._device_handle, table)
+        if table_DE is None:
+            table_DE = [[[0.0, 0.0] for j in range(self.NCHAN_DE)] for i in range(self.NGAINS_USB1208FS_PLUS)]
         for i in range(self.NGAINS_USB1208FS_PLUS):
             for j in range(self.NCHAN_DE):
                 for k in range(2):
-                    table[i][j][k] = table_DE[i][j][k]
-        f(self._device_handle, table)
+                    table_DE[i][j][k] = table[i][j][k]
+        return table_DE
+
+    def buildGainTableSE(self, table_SE=None):
+        """Read the single-ended calibration table from the device.
 
-    def buildGainTableSE(self, table_SE):
+        Returns the table, indexed ``[channel][slope/offset]``. If
+        ``table_SE`` is given it is filled in as well.
+        """
         # void usbBuildGainTable_SE_USB1208FS_Plus(libusb_device_handle *udev, float table_SE[NCHAN_SE][2]);
         table_type = c_float * 2 * self.NCHAN_SE
-        f = getfunc('usbBuildGainTable_SE_USB1208FS_Plus', [c_void_p, table_type], None)
+        f = self._func('usbBuildGainTable_SE_USB1208FS_Plus', [c_void_p, table_type], None)
         table = table_type()
+        f(self._device_handle, table)
+        if table_SE is None:
+            table_SE = [[0.0, 0.0] for i in range(self.NCHAN_SE)]
         for i in range(self.NCHAN_SE):
             for j in range(2):
-                table[i][j] = table_SE[i][j]
-        f(self._device_handle, table)
+                table_SE[i][j] = table[i][j]
+        return table_SE
 
     def volts(self, value, range_):
         # double volts_USB1208FS_Plus(uint16_t value, uint8_t range);
-        f = getfunc('volts_USB1208FS_Plus', [c_uint16, c_uint8], c_double)
+        f = self._func('volts_USB1208FS_Plus', [c_uint16, c_uint8], c_double)
         return f(value, range_)
 
+    def scanConverter(self, channels, ranges, differential=True, table=None):
+        """Set up the conversion of scan data to calibrated volts.
+
+        ``channels`` is the channel bit mask passed to ``aInScanStart``
+        and ``ranges`` the ranges passed to ``aInScanConfig`` (ignored in
+        single-ended mode, which is always +/- 10V). ``table`` is the
+        result of ``buildGainTableDE`` or ``buildGainTableSE``; it is
+        read from the device if not given. The returned object is
+        passed to ``aInScanVolts``.
+        """
+        # int usbScanConvertInit(usbScanConvert *conv, int nChan, uint32_t maxCode, const double slope[], const double offset[],
+        #                        const double base[], const double lsb[]);
+        f = self._func('usbScanConvertInit', [POINTER(ScanConvert), c_int, c_uint32] + [POINTER(c_double)] * 4, c_int)
+        if table is None:
+            table = self.buildGainTableDE() if differential else self.buildGainTableSE()
+        nchan_max = self.NCHAN_DE if differential else self.NCHAN_SE
+        slope, offset, base, lsb = [], [], [], []
+        for channel in range(nchan_max):
+            if not channels & (0x1 << channel):
+                continue
+            if differential:
+                range_ = ranges[channel]
+                cal = table[range_][channel]
+            else:
+                range_ = self.BP_10V
+                cal = table[channel]
+            slope.append(cal[0])
+            offset.append(cal[1])
+            base.append(self.volts(0, range_))
+            lsb.append(self.volts(1, range_) - base[-1])
+        conv = ScanConvert()
+        args = [sequence_to_array(x, c_double) for x in (slope, offset, base, lsb)]
+        if f(byref(conv), len(slope), self.ADC_MAX, *args) < 0:
+            raise ValueError('no channels selected')
+        return conv
+
+    def aInScanVolts(self, data, converter, out=None, first=0):
+        """Convert raw scan data to calibrated volts in one call.
+
+        ``data`` is a ``numpy.uint16`` array (or buffer) as filled by
+        ``aInScanRead`` or yielded by ``aInScanBlocks`` and
+        ``converter`` comes from ``scanConverter``. The result has the
+        shape of ``data``; it is written into ``out`` if given, which
+        must be a ``numpy.float64`` or ``numpy.float32`` array, and
+        returned. ``first`` is the position in the scan of the first
+        sample, for buffers that do not start on a scan boundary.
+        """
+        if numpy is None:
+            raise RuntimeError('aInScanVolts requires NumPy')
+        data = numpy.ascontiguousarray(data, dtype=numpy.uint16)
+        if out is None:
+            out = numpy.empty(data.shape, dtype=numpy.float64)
+        n = data.size
+        if out.dtype == numpy.float32:
+            # void usbScanConvert16f(const usbScanConvert *conv, const uint16_t *raw, float *volts, size_t nSamples, int first);
+            f = self._func('usbScanConvert16f', [POINTER(ScanConvert), POINTER(c_uint16), POINTER(c_float), c_size_t, c_int], None)
+            volts = buffer_to_array(out, c_float, n)
+        else:
+            # void usbScanConvert16(const usbScanConvert *conv, const uint16_t *raw, double *volts, size_t nSamples, int first);
+            f = self._func('usbScanConvert16', [POINTER(ScanConvert), POINTER(c_uint16), POINTER(c_double), c_size_t, c_int], None)
+            volts = buffer_to_array(out, c_double, n)
+        raw = data.ctypes.data_as(POINTER(c_uint16))
+        f(byref(converter), raw, volts, n, first)
+        return out
+
     # TODO: Construt struct tm in Python
     # void usbCalDate_USB1208FS_Plus(libusb_device_handle *udev, struct tm *date);
 
@@ -354,10 +565,12 @@ class MCCUSB1408FSPlusDevice(MCCUSB1208FSPlusDevice):
 
     PRODUCT_ID = 0x00e9
 
+    ADC_MAX = 0x3fff  # full scale code of the 14 bit A/D
+
     def __init__(self):
         MCCUSBDevice.__init__(self, 'USB-1408FS-Plus', self.PRODUCT_ID)
 
     def volts(self, value, range_):
         # double volts_USB1408FS_Plus(uint16_t value, uint8_t range);
-        f = getfunc('volts_USB1408FS_Plus', [c_uint16, c_uint8], c_double)
+        f = self._func('volts_USB1408FS_Plus', [c_uint16, c_uint8], c_double)
         return f(value, range_)